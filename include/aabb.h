@@ -0,0 +1,79 @@
+#ifndef AABB_H
+#define AABB_H
+
+#include "rtweekend.h"
+
+#include <algorithm>
+
+class AABB {
+public:
+    point3 minimum;
+    point3 maximum;
+
+    // an empty box, growing it by anything yields that thing
+    AABB() : minimum(infinity, infinity, infinity), maximum(-infinity, -infinity, -infinity) {}
+    AABB(const point3& a, const point3& b) : minimum(a), maximum(b) {}
+
+    bool empty() const {
+        return minimum.x > maximum.x || minimum.y > maximum.y || minimum.z > maximum.z;
+    }
+
+    Vec3 extent() const { return maximum - minimum; }
+
+    point3 centroid() const { return 0.5 * (minimum + maximum); }
+
+    double surfaceArea() const {
+        if (empty()) return 0;
+        auto d = extent();
+        return 2 * (d.x * d.y + d.y * d.z + d.z * d.x);
+    }
+
+    int longestAxis() const {
+        auto d = extent();
+        if (d.x > d.y && d.x > d.z) return 0;
+        return d.y > d.z ? 1 : 2;
+    }
+
+    void grow(const point3& p) {
+        for (int a = 0; a < 3; ++a) {
+            minimum[a] = std::min(minimum[a], p[a]);
+            maximum[a] = std::max(maximum[a], p[a]);
+        }
+    }
+
+    void grow(const AABB& b) {
+        if (b.empty()) return;
+        grow(b.minimum);
+        grow(b.maximum);
+    }
+
+    // slab test, on a hit [t_enter, t_exit] is the part of [t_min, t_max] inside the box
+    bool hit(const Ray& r, double t_min, double t_max, double& t_enter, double& t_exit) const {
+        for (int a = 0; a < 3; ++a) {
+            auto inv_d = 1.0 / r.dir[a];
+            auto t0 = (minimum[a] - r.origin[a]) * inv_d;
+            auto t1 = (maximum[a] - r.origin[a]) * inv_d;
+            if (inv_d < 0.0) std::swap(t0, t1);
+            // NaN from 0 * inf keeps the current bound
+            t_min = t0 > t_min ? t0 : t_min;
+            t_max = t1 < t_max ? t1 : t_max;
+            if (t_max < t_min) return false;
+        }
+        t_enter = t_min;
+        t_exit = t_max;
+        return true;
+    }
+
+    bool hit(const Ray& r, double t_min, double t_max) const {
+        double t_enter, t_exit;
+        return hit(r, t_min, t_max, t_enter, t_exit);
+    }
+};
+
+inline AABB surrounding_box(const AABB& a, const AABB& b) {
+    AABB box = a;
+    box.grow(b);
+    return box;
+}
+
+#endif //AABB_H
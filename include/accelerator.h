@@ -0,0 +1,37 @@
+#ifndef ACCELERATOR_H
+#define ACCELERATOR_H
+
+#include "hittable.h"
+#include "hittable_list.h"
+
+#include <vector>
+
+// common interface of the ray intersection structures built over a scene
+class Accelerator : public Hittable {
+public:
+    virtual const char* name() const = 0;
+};
+
+// brute force, tests every object
+class ListAccelerator : public Accelerator {
+public:
+    explicit ListAccelerator(const std::vector<shared_ptr<Hittable>>& objects) {
+        for (const auto& object : objects)
+            list.add(object);
+    }
+
+    virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override {
+        return list.hit(r, t_min, t_max, rec);
+    }
+
+    virtual bool boundingBox(AABB& output_box) const override {
+        return list.boundingBox(output_box);
+    }
+
+    virtual const char* name() const override { return "list"; }
+
+private:
+    HittableList list;
+};
+
+#endif //ACCELERATOR_H
@@ -0,0 +1,42 @@
+#ifndef ACCELERATORS_H
+#define ACCELERATORS_H
+
+#include "accelerator.h"
+#include "bvh.h"
+#include "grid.h"
+
+#include <string>
+
+enum class AcceleratorType {
+    List,
+    Bvh,
+    Grid,
+};
+
+const AcceleratorType all_accelerators[] = {
+    AcceleratorType::List,
+    AcceleratorType::Bvh,
+    AcceleratorType::Grid,
+};
+
+// returns false for unknown names
+inline bool parse_accelerator(const std::string& name, AcceleratorType& type) {
+    if (name == "list") type = AcceleratorType::List;
+    else if (name == "bvh") type = AcceleratorType::Bvh;
+    else if (name == "grid") type = AcceleratorType::Grid;
+    else return false;
+    return true;
+}
+
+inline shared_ptr<Accelerator> make_accelerator(AcceleratorType type, const HittableList& world) {
+    switch (type) {
+    case AcceleratorType::Bvh:
+        return make_shared<Bvh>(world.getObjects());
+    case AcceleratorType::Grid:
+        return make_shared<UniformGrid>(world.getObjects());
+    default:
+        return make_shared<ListAccelerator>(world.getObjects());
+    }
+}
+
+#endif //ACCELERATORS_H
@@ -0,0 +1,108 @@
+#ifndef ANIMATION_H
+#define ANIMATION_H
+
+#include "rtweekend.h"
+#include "sphere.h"
+#include "scene.h"
+
+#include <tbb/tbb.h>
+#include <string>
+#include <vector>
+
+struct Keyframe {
+    double time;
+    Vec3 translation;
+    double scale;
+};
+
+// keyframed transform, linear between keys and held before the first and after the last
+class Animation {
+public:
+    void addKey(double time, const Vec3& translation, double scale = 1.0) {
+        auto it = keys.begin();
+        while (it != keys.end() && it->time <= time) ++it;
+        keys.insert(it, Keyframe{time, translation, scale});
+    }
+
+    Keyframe at(double time) const {
+        if (keys.empty()) return Keyframe{time, Vec3(0, 0, 0), 1.0};
+        if (time <= keys.front().time) return keys.front();
+        if (time >= keys.back().time) return keys.back();
+
+        size_t k = 1;
+        while (keys[k].time < time) ++k;
+        const auto& a = keys[k - 1];
+        const auto& b = keys[k];
+        auto f = (time - a.time) / (b.time - a.time);
+        return Keyframe{time, (1 - f) * a.translation + f * b.translation, (1 - f) * a.scale + f * b.scale};
+    }
+
+private:
+    std::vector<Keyframe> keys;
+};
+
+// a sphere whose center and radius follow an animation relative to its rest pose
+class AnimatedSphere : public Sphere {
+public:
+    AnimatedSphere(const Vec3& cen, double r, shared_ptr<Material> m, Animation a)
+        : Sphere(cen, r, std::move(m)), rest_center(cen), rest_radius(r), animation(std::move(a)) {}
+
+    void setTime(double time) {
+        auto key = animation.at(time);
+        center = rest_center + key.translation;
+        radius = rest_radius * key.scale;
+    }
+
+private:
+    Vec3 rest_center;
+    double rest_radius;
+    Animation animation;
+};
+
+struct AnimatedScene {
+    Scene scene;  // world holds the animated spheres as well
+    std::vector<shared_ptr<AnimatedSphere>> animated;
+
+    void setTime(double time) {
+        tbb::parallel_for(size_t(0), animated.size(), [&](size_t i) { animated[i]->setTime(time); });
+    }
+};
+
+// random_scene() with the small spheres bouncing and drifting over time [0, 1]
+inline AnimatedScene random_animated_scene() {
+    AnimatedScene animated;
+    make_scene("random", animated.scene);
+
+    HittableList world;
+    for (const auto& object : animated.scene.world.getObjects()) {
+        auto sphere = std::dynamic_pointer_cast<Sphere>(object);
+        if (!sphere || sphere->radius > 0.5) {
+            world.add(object);
+            continue;
+        }
+
+        auto drift = Vec3(random_double(-0.5, 0.5), 0, random_double(-0.5, 0.5));
+        auto height = random_double(0.2, 1.0);
+        Animation bounce;
+        bounce.addKey(0.0, Vec3(0, 0, 0));
+        bounce.addKey(0.5, 0.5 * drift + Vec3(0, height, 0), 1.2);
+        bounce.addKey(1.0, drift);
+
+        auto moving = make_shared<AnimatedSphere>(sphere->center, sphere->radius, sphere->mat_ptr, bounce);
+        animated.animated.push_back(moving);
+        world.add(moving);
+    }
+    animated.scene.world = world;
+    return animated;
+}
+
+// build one of the canned animated scenes by name, returns false for unknown names
+inline bool make_animated_scene(const std::string& name, AnimatedScene& scene) {
+    if (name == "random") {
+        scene = random_animated_scene();
+        return true;
+    }
+    return false;
+}
+
+#endif //ANIMATION_H
@@ -0,0 +1,201 @@
+#ifndef BVH_H
+#define BVH_H
+
+#include "accelerator.h"
+#include "aabb.h"
+
+#include <tbb/tbb.h>
+#include <algorithm>
+#include <atomic>
+#include <numeric>
+#include <vector>
+
+// Bounding volume hierarchy with one object per leaf, stored depth first:
+// the left child of node n is n + 1, the right child is stored in the node.
+//
+// A subtree over k objects always takes 2k - 1 consecutive nodes, so after
+// objects move it can either be refitted or rebuilt in place.
+class Bvh : public Accelerator {
+public:
+    explicit Bvh(const std::vector<shared_ptr<Hittable>>& objects) {
+        for (const auto& object : objects) {
+            AABB box;
+            if (object->boundingBox(box)) {
+                prims.push_back(object);
+                boxes.push_back(box);
+            } else {
+                unbounded.push_back(object);
+            }
+        }
+        if (prims.empty()) return;
+
+        std::vector<int> order(prims.size());
+        std::iota(order.begin(), order.end(), 0);
+        nodes.resize(2 * prims.size() - 1);
+        build(0, order.data(), 0, static_cast<int>(order.size()));
+    }
+
+    virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+
+    virtual bool boundingBox(AABB& output_box) const override {
+        if (!unbounded.empty() || nodes.empty()) return false;
+        output_box = nodes[0].box;
+        return true;
+    }
+
+    virtual const char* name() const override { return "bvh"; }
+
+    // recompute every box bottom up from the current object bounds
+    void refit() {
+        if (!nodes.empty()) refit(0, static_cast<int>(prims.size()));
+    }
+
+    // Rebuild the topmost subtrees whose surface area grew past max_growth
+    // times the area they had when built, call after refit(). Returns the
+    // number of subtrees rebuilt.
+    int rebuildDegraded(double max_growth) {
+        std::atomic<int> rebuilt{0};
+        if (!nodes.empty()) rebuildDegraded(0, static_cast<int>(prims.size()), max_growth, rebuilt);
+        return rebuilt;
+    }
+
+private:
+    struct Node {
+        AABB box;
+        double build_area;  // surface area right after the last build
+        int right;  // -1 for a leaf
+        int prim;   // leaf only
+        int axis;   // split axis, inner nodes only
+    };
+
+    // subtrees with fewer objects are refitted or rebuilt serially
+    static const int parallel_grain = 64;
+
+    std::vector<shared_ptr<Hittable>> prims;
+    std::vector<AABB> boxes;
+    std::vector<shared_ptr<Hittable>> unbounded;
+    std::vector<Node> nodes;
+
+    // builds the subtree over order[begin, end) at node n, it takes 2 * (end - begin) - 1 nodes
+    void build(int n, int* order, int begin, int end) {
+        Node& node = nodes[n];
+        node.box = AABB();
+        if (end - begin == 1) {
+            node.box = boxes[order[begin]];
+            node.build_area = node.box.surfaceArea();
+            node.right = -1;
+            node.prim = order[begin];
+            return;
+        }
+
+        AABB centroids;
+        for (int i = begin; i < end; ++i)
+            centroids.grow(boxes[order[i]].centroid());
+        int axis = centroids.longestAxis();
+
+        // median split keeps both halves non-empty even for coincident centroids
+        int mid = begin + (end - begin) / 2;
+        std::nth_element(order + begin, order + mid, order + end, [&](int a, int b) {
+            return boxes[a].centroid()[axis] < boxes[b].centroid()[axis];
+        });
+
+        node.axis = axis;
+        node.right = n + 2 * (mid - begin);
+        node.prim = -1;
+        build(n + 1, order, begin, mid);
+        build(node.right, order, mid, end);
+        node.box = surrounding_box(nodes[n + 1].box, nodes[node.right].box);
+        node.build_area = node.box.surfaceArea();
+    }
+
+    // n is the subtree root, count the number of objects below it
+    void refit(int n, int count) {
+        Node& node = nodes[n];
+        if (node.right < 0) {
+            prims[node.prim]->boundingBox(boxes[node.prim]);
+            node.box = boxes[node.prim];
+            return;
+        }
+
+        int left_count = (node.right - n) / 2;
+        if (count >= parallel_grain) {
+            tbb::parallel_invoke([&] { refit(n + 1, left_count); },
+                                 [&] { refit(node.right, count - left_count); });
+        } else {
+            refit(n + 1, left_count);
+            refit(node.right, count - left_count);
+        }
+        node.box = surrounding_box(nodes[n + 1].box, nodes[node.right].box);
+    }
+
+    void rebuildDegraded(int n, int count, double max_growth, std::atomic<int>& rebuilt) {
+        Node& node = nodes[n];
+        if (node.right < 0) return;
+
+        if (node.box.surfaceArea() > max_growth * node.build_area) {
+            // the subtree spans nodes [n, n + 2 * count - 1), gather its objects
+            std::vector<int> order;
+            order.reserve(count);
+            for (int i = n; i < n + 2 * count - 1; ++i)
+                if (nodes[i].right < 0) order.push_back(nodes[i].prim);
+            build(n, order.data(), 0, count);
+            rebuilt++;
+            return;
+        }
+
+        int left_count = (node.right - n) / 2;
+        if (count >= parallel_grain) {
+            tbb::parallel_invoke([&] { rebuildDegraded(n + 1, left_count, max_growth, rebuilt); },
+                                 [&] { rebuildDegraded(node.right, count - left_count, max_growth, rebuilt); });
+        } else {
+            rebuildDegraded(n + 1, left_count, max_growth, rebuilt);
+            rebuildDegraded(node.right, count - left_count, max_growth, rebuilt);
+        }
+    }
+};
+
+inline bool Bvh::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+    HitRecord temp_rec;
+    bool hit_anything = false;
+    auto closest_so_far = t_max;
+
+    for (const auto& object : unbounded) {
+        if (object->hit(r, t_min, closest_so_far, temp_rec)) {
+            hit_anything = true;
+            closest_so_far = temp_rec.t;
+            rec = temp_rec;
+        }
+    }
+    if (nodes.empty()) return hit_anything;
+
+    int stack[64];
+    int top = 0;
+    stack[top++] = 0;
+    while (top > 0) {
+        const Node& node = nodes[stack[--top]];
+        if (!node.box.hit(r, t_min, closest_so_far)) continue;
+
+        if (node.right < 0) {
+            if (prims[node.prim]->hit(r, t_min, closest_so_far, temp_rec)) {
+                hit_anything = true;
+                closest_so_far = temp_rec.t;
+                rec = temp_rec;
+            }
+            continue;
+        }
+
+        // visit the near child first so the far one is often culled
+        int left = static_cast<int>(&node - nodes.data()) + 1;
+        if (r.dir[node.axis] < 0) {
+            stack[top++] = left;
+            stack[top++] = node.right;
+        } else {
+            stack[top++] = node.right;
+            stack[top++] = left;
+        }
+    }
+
+    return hit_anything;
+}
+
+#endif //BVH_H
@@ -5,7 +5,7 @@
 
 #include <iostream>
 
-void write_color(std::ostream& out, color pixel_color, int samples_per_pixel) {  
+inline void write_color(std::ostream& out, color pixel_color, int samples_per_pixel) {  
     auto r = pixel_color.x;
     auto g = pixel_color.y;
     auto b = pixel_color.z;
@@ -0,0 +1,202 @@
+#ifndef GRID_H
+#define GRID_H
+
+#include "accelerator.h"
+#include "aabb.h"
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+// Uniform grid traversed with a 3D-DDA.
+//
+// Objects much larger than the typical one (the ground sphere of
+// random_scene() is 5000 times the size of the others) would overlap every
+// cell and stretch the grid bounds, so they are kept out of the grid in a
+// side list that is tested for every ray before the grid walk.
+class UniformGrid : public Accelerator {
+public:
+    // density: cells per object, huge_factor: how many times the median
+    // object diagonal an object may span before it goes to the side list
+    explicit UniformGrid(const std::vector<shared_ptr<Hittable>>& objects,
+                         double density = 3.0, double huge_factor = 32.0) {
+        std::vector<AABB> all_boxes;
+        std::vector<shared_ptr<Hittable>> bounded;
+        std::vector<double> diagonals;
+        for (const auto& object : objects) {
+            AABB box;
+            if (object->boundingBox(box)) {
+                bounded.push_back(object);
+                all_boxes.push_back(box);
+                diagonals.push_back(box.extent().length());
+            } else {
+                huge.push_back(object);
+            }
+        }
+        if (bounded.empty()) return;
+
+        auto mid = diagonals.begin() + diagonals.size() / 2;
+        std::nth_element(diagonals.begin(), mid, diagonals.end());
+        auto limit = huge_factor * *mid;
+
+        std::vector<AABB> boxes;
+        for (size_t i = 0; i < bounded.size(); ++i) {
+            if (all_boxes[i].extent().length() > limit) {
+                huge.push_back(bounded[i]);
+            } else {
+                prims.push_back(bounded[i]);
+                boxes.push_back(all_boxes[i]);
+                bounds.grow(all_boxes[i]);
+            }
+        }
+        if (prims.empty()) return;
+
+        // flat scenes still need some thickness for the cell size
+        auto d = bounds.extent();
+        auto pad = 1e-4 * std::max(1.0, d.length());
+        bounds.grow(bounds.minimum - Vec3(pad, pad, pad));
+        bounds.grow(bounds.maximum + Vec3(pad, pad, pad));
+        d = bounds.extent();
+
+        auto cells_per_unit = std::cbrt(density * prims.size() / (d.x * d.y * d.z));
+        for (int a = 0; a < 3; ++a) {
+            res[a] = static_cast<int>(std::clamp(d[a] * cells_per_unit, 1.0, 256.0));
+            cell_size[a] = d[a] / res[a];
+        }
+
+        // two passes over the overlapped cells, count then fill
+        cell_start.assign(res[0] * res[1] * res[2] + 1, 0);
+        for (const auto& box : boxes)
+            forEachCell(box, [&](int c) { cell_start[c + 1]++; });
+        for (size_t c = 1; c < cell_start.size(); ++c)
+            cell_start[c] += cell_start[c - 1];
+
+        cell_prims.resize(cell_start.back());
+        std::vector<int> fill(cell_start.begin(), cell_start.end() - 1);
+        for (size_t i = 0; i < boxes.size(); ++i)
+            forEachCell(boxes[i], [&](int c) { cell_prims[fill[c]++] = static_cast<int>(i); });
+    }
+
+    virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
+
+    virtual bool boundingBox(AABB& output_box) const override {
+        output_box = bounds;
+        for (const auto& object : huge) {
+            AABB box;
+            if (!object->boundingBox(box)) return false;
+            output_box.grow(box);
+        }
+        return !output_box.empty();
+    }
+
+    virtual const char* name() const override { return "grid"; }
+
+private:
+    std::vector<shared_ptr<Hittable>> huge;
+    std::vector<shared_ptr<Hittable>> prims;
+
+    AABB bounds;
+    int res[3] = {0, 0, 0};
+    Vec3 cell_size;
+    // objects of cell c are cell_prims[cell_start[c], cell_start[c + 1])
+    std::vector<int> cell_start;
+    std::vector<int> cell_prims;
+
+    int cellCoord(double p, int axis) const {
+        auto c = static_cast<int>((p - bounds.minimum[axis]) / cell_size[axis]);
+        return std::clamp(c, 0, res[axis] - 1);
+    }
+
+    template <typename F>
+    void forEachCell(const AABB& box, F f) const {
+        int lo[3], hi[3];
+        for (int a = 0; a < 3; ++a) {
+            lo[a] = cellCoord(box.minimum[a], a);
+            hi[a] = cellCoord(box.maximum[a], a);
+        }
+        for (int z = lo[2]; z <= hi[2]; ++z)
+            for (int y = lo[1]; y <= hi[1]; ++y)
+                for (int x = lo[0]; x <= hi[0]; ++x)
+                    f((z * res[1] + y) * res[0] + x);
+    }
+};
+
+inline bool UniformGrid::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+    HitRecord temp_rec;
+    bool hit_anything = false;
+    auto closest_so_far = t_max;
+
+    for (const auto& object : huge) {
+        if (object->hit(r, t_min, closest_so_far, temp_rec)) {
+            hit_anything = true;
+            closest_so_far = temp_rec.t;
+            rec = temp_rec;
+        }
+    }
+    if (prims.empty()) return hit_anything;
+
+    // the walk below never leaves the grid on NaN steps, the slab test lets them through
+    for (int a = 0; a < 3; ++a)
+        if (!std::isfinite(r.origin[a]) || !std::isfinite(r.dir[a])) return hit_anything;
+
+    double t_enter, t_exit;
+    if (!bounds.hit(r, t_min, closest_so_far, t_enter, t_exit)) return hit_anything;
+
+    int cell[3], step[3], out[3];
+    double t_next[3], t_delta[3];
+    auto entry = r.at(t_enter);
+    for (int a = 0; a < 3; ++a) {
+        cell[a] = cellCoord(entry[a], a);
+        if (r.dir[a] > 0) {
+            step[a] = 1;
+            out[a] = res[a];
+            t_next[a] = (bounds.minimum[a] + (cell[a] + 1) * cell_size[a] - r.origin[a]) / r.dir[a];
+            t_delta[a] = cell_size[a] / r.dir[a];
+        } else if (r.dir[a] < 0) {
+            step[a] = -1;
+            out[a] = -1;
+            t_next[a] = (bounds.minimum[a] + cell[a] * cell_size[a] - r.origin[a]) / r.dir[a];
+            t_delta[a] = -cell_size[a] / r.dir[a];
+        } else {
+            step[a] = 0;
+            out[a] = -1;
+            t_next[a] = infinity;
+            t_delta[a] = infinity;
+        }
+    }
+
+    // Mailbox of recently tested objects, so an object spanning several cells
+    // is intersected once per ray. It lives on the stack to stay thread safe;
+    // a collision only costs a repeated test. An object hit beyond the current
+    // cell is already in closest_so_far, skipping it later loses nothing.
+    int mailbox[16];
+    std::fill(std::begin(mailbox), std::end(mailbox), -1);
+
+    while (true) {
+        int c = (cell[2] * res[1] + cell[1]) * res[0] + cell[0];
+        for (int k = cell_start[c]; k < cell_start[c + 1]; ++k) {
+            int p = cell_prims[k];
+            if (mailbox[p & 15] == p) continue;
+            mailbox[p & 15] = p;
+            if (prims[p]->hit(r, t_min, closest_so_far, temp_rec)) {
+                hit_anything = true;
+                closest_so_far = temp_rec.t;
+                rec = temp_rec;
+            }
+        }
+
+        int axis = 0;
+        if (t_next[1] < t_next[axis]) axis = 1;
+        if (t_next[2] < t_next[axis]) axis = 2;
+
+        // nothing in a later cell can be closer than a hit inside this one
+        if (closest_so_far <= t_next[axis] || t_next[axis] > t_exit) break;
+        cell[axis] += step[axis];
+        if (cell[axis] == out[axis]) break;
+        t_next[axis] += t_delta[axis];
+    }
+
+    return hit_anything;
+}
+
+#endif //GRID_H
@@ -2,6 +2,7 @@
 #define HITTABLE_H
 
 #include "ray.h"
+#include "aabb.h"
 
 #include <memory>
 
@@ -24,6 +25,8 @@ struct HitRecord {
 class Hittable {
 public:
     virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const = 0;
+    // false for objects without finite bounds
+    virtual bool boundingBox(AABB& output_box) const = 0;
 };
 
 #endif
@@ -23,11 +23,17 @@ public:
     virtual bool hit(
         const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
 
+    virtual bool boundingBox(AABB& output_box) const override;
+
+    const std::vector<shared_ptr<Hittable>>& getObjects() const {
+        return objects;
+    }
+
 private:
     std::vector<shared_ptr<Hittable>> objects;
 };
 
-bool HittableList::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+inline bool HittableList::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
     HitRecord temp_rec;
     bool hit_anything = false;
     auto closest_so_far = t_max;
@@ -43,4 +49,17 @@ bool HittableList::hit(const Ray& r, double t_min, double t_max, HitRecord& rec)
     return hit_anything;
 }
 
+inline bool HittableList::boundingBox(AABB& output_box) const {
+    if (objects.empty()) return false;
+
+    AABB temp_box;
+    output_box = AABB();
+    for (const auto& object : objects) {
+        if (!object->boundingBox(temp_box)) return false;
+        output_box.grow(temp_box);
+    }
+
+    return true;
+}
+
 #endif
@@ -10,6 +10,9 @@ class Material {
 public:
     virtual bool scatter(const Ray& r_in, const HitRecord& rec,
             color& attenuation, Ray& scattered) const = 0;
+
+    // ideal diffuse, outgoing radiance does not depend on the view direction
+    virtual bool isDiffuse() const { return false; }
 };
 
 class Lambertian : public Material {
@@ -26,6 +29,8 @@ public:
         attenuation = albedo;
         return true;
     }
+
+    virtual bool isDiffuse() const override { return true; }
 };
 
 class Metal : public Material {
@@ -30,7 +30,13 @@ public:
         std::cerr << "\rcomplete " << comp / 1.0 / width / height * 100 << "% " << std::flush;
     }
 
-    void write_to_file(const std::string& file_name = "output.ppm") {
+    // add a pass worth of samples, samples_per_pixel has to track the total
+    void accumulate(int i, int j, const color& c) {
+        ppm[i][j] += c;
+    }
+
+    // false when the file cannot be opened or written
+    bool write_to_file(const std::string& file_name = "output.ppm") {
         std::ofstream os;
         os.open(file_name, std::ios::out);
         os << "P3\n" << width << " " << height << "\n255\n";
@@ -38,6 +44,7 @@ public:
             for (int i = 0; i < width; ++i)
                 write_color(os, ppm[i][j], samples_per_pixel);
         os.close();
+        return static_cast<bool>(os);
     }
 };
 
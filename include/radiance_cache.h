@@ -0,0 +1,155 @@
+#ifndef RADIANCE_CACHE_H
+#define RADIANCE_CACHE_H
+
+#include "rtweekend.h"
+
+#include <algorithm>
+#include <atomic>
+#include <cstdint>
+#include <vector>
+
+// Hashed grid of the radiance arriving at diffuse surfaces.
+//
+// Samples are keyed by the cell of their position and the dominant axis of
+// the surface normal, so the two sides of a thin object do not mix. A cell
+// answers lookups once it holds min_samples samples and the standard error
+// of their mean luminance is within tolerance of the mean; larger cells and
+// tolerances reuse more and blur more.
+class RadianceCache {
+public:
+    double cell_size;
+    int min_samples;
+    double tolerance;
+
+    // a diffuse vertex reads the cache only when this many diffuse vertices
+    // precede it, 1 keeps the first diffuse hit seen from the camera exact
+    int min_reuse_depth = 1;
+    // while set, lookups miss and every diffuse vertex adds a sample
+    bool populating = false;
+
+    // capacity is rounded up to a power of two, samples for new cells are
+    // dropped once their probe window is full
+    RadianceCache(double cs = 0.1, int ms = 8, double tol = 0.2, size_t capacity = 1 << 18)
+        : cell_size(cs), min_samples(ms), tolerance(tol) {
+        size_t n = 1;
+        while (n < capacity) n <<= 1;
+        table = std::vector<Entry>(n);
+        mask = n - 1;
+    }
+
+    bool lookup(const point3& p, const Vec3& n, color& radiance) const {
+        if (populating) return false;
+
+        const Entry* e = find(key(p, n));
+        if (!e || e->count.load(std::memory_order_acquire) < min_samples) return false;
+
+        EntryLock lock(*e);
+        auto count = e->count.load(std::memory_order_relaxed);
+        auto mean = e->luminance / count;
+        auto variance = std::max(0.0, e->luminance_sqrd / count - mean * mean);
+        if (std::sqrt(variance / count) > tolerance * std::max(mean, 1e-4)) return false;
+
+        radiance = e->radiance / count;
+        return true;
+    }
+
+    void insert(const point3& p, const Vec3& n, const color& radiance) {
+        auto k = key(p, n);
+        auto first = slot(k);
+        for (int probe = 0; probe < max_probes; ++probe) {
+            Entry& e = table[(first + probe) & mask];
+            auto current = e.key.load(std::memory_order_acquire);
+            if (current == 0) {
+                // claim the empty slot, someone else may have claimed it first
+                if (!e.key.compare_exchange_strong(current, k) && current != k) continue;
+            } else if (current != k) {
+                continue;
+            }
+
+            auto l = luminance(radiance);
+            EntryLock lock(e);
+            e.radiance += radiance;
+            e.luminance += l;
+            e.luminance_sqrd += l * l;
+            e.count.fetch_add(1, std::memory_order_release);
+            return;
+        }
+    }
+
+    size_t size() const {
+        size_t used = 0;
+        for (const auto& e : table)
+            if (e.key.load(std::memory_order_relaxed) != 0) used++;
+        return used;
+    }
+
+    void clear() {
+        for (auto& e : table) {
+            e.key = 0;
+            e.count = 0;
+            e.radiance = color(0, 0, 0);
+            e.luminance = e.luminance_sqrd = 0;
+        }
+    }
+
+private:
+    struct Entry {
+        std::atomic<uint64_t> key{0};  // 0 marks an empty slot
+        std::atomic<int> count{0};
+        mutable std::atomic_flag busy = ATOMIC_FLAG_INIT;
+        color radiance;
+        double luminance = 0;
+        double luminance_sqrd = 0;
+    };
+
+    struct EntryLock {
+        const Entry& e;
+        explicit EntryLock(const Entry& en) : e(en) {
+            while (e.busy.test_and_set(std::memory_order_acquire)) {}
+        }
+        ~EntryLock() { e.busy.clear(std::memory_order_release); }
+    };
+
+    static const int max_probes = 8;
+
+    std::vector<Entry> table;
+    size_t mask;
+
+    static double luminance(const color& c) {
+        return 0.2126 * c.x + 0.7152 * c.y + 0.0722 * c.z;
+    }
+
+    // splitmix64 finalizer, every key bit reaches the low bits kept by the mask
+    static size_t slot(uint64_t k) {
+        k = (k ^ (k >> 30)) * 0xbf58476d1ce4e5b9ull;
+        k = (k ^ (k >> 27)) * 0x94d049bb133111ebull;
+        return static_cast<size_t>(k ^ (k >> 31));
+    }
+
+    const Entry* find(uint64_t k) const {
+        auto first = slot(k);
+        for (int probe = 0; probe < max_probes; ++probe) {
+            const Entry& e = table[(first + probe) & mask];
+            auto current = e.key.load(std::memory_order_acquire);
+            if (current == k) return &e;
+            if (current == 0) return nullptr;
+        }
+        return nullptr;
+    }
+
+    // 19 bits per cell coordinate and 3 for the normal, far away cells may
+    // alias. The top bit is always set so no key is 0.
+    uint64_t key(const point3& p, const Vec3& n) const {
+        uint64_t k = 0;
+        for (int a = 0; a < 3; ++a) {
+            auto c = static_cast<int64_t>(std::floor(p[a] / cell_size));
+            k = (k << 19) | (static_cast<uint64_t>(c) & 0x7ffff);
+        }
+        int axis = 0;
+        if (std::fabs(n.y) > std::fabs(n[axis])) axis = 1;
+        if (std::fabs(n.z) > std::fabs(n[axis])) axis = 2;
+        return (1ull << 63) | (k << 3) | static_cast<uint64_t>(2 * axis + (n[axis] < 0));
+    }
+};
+
+#endif //RADIANCE_CACHE_H
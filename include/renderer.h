@@ -0,0 +1,112 @@
+#ifndef RENDERER_H
+#define RENDERER_H
+
+#include "rtweekend.h"
+#include "hittable.h"
+#include "material.h"
+#include "camera.h"
+#include "ppm.h"
+#include "radiance_cache.h"
+
+#include <tbb/tbb.h>
+#include <atomic>
+
+struct tbb_shading{
+    PPM& image;
+    Camera& camera;
+    const Hittable& scene;
+
+    int width;
+    int height;
+    int samples_per_pixel;
+    int max_depth;
+
+    // progressive passes add into the image instead of overwriting it
+    bool accumulate = false;
+    // checked once per tile, a set flag stops the remaining tiles
+    const std::atomic<bool>* cancelled = nullptr;
+    // when set, indirect diffuse radiance is read from and added to the cache
+    RadianceCache* cache = nullptr;
+    // when set, receives the number of samples traced after every tile
+    std::atomic<long>* progress = nullptr;
+
+    tbb_shading(PPM& p, Camera& c, const Hittable& s, int w, int h, int sp, int m)
+        : image(p)
+        , camera(c)
+        , scene(s)
+        , width(w)
+        , height(h)
+        , samples_per_pixel(sp)
+        , max_depth(m){
+
+    }
+
+    [[nodiscard]] static color rayCast(const Ray& r, const Hittable& world, int depth)  {
+        HitRecord rec;
+        if (depth <= 0) return {0, 0, 0};
+        if (world.hit(r, 0.001, infinity, rec)) {
+            Ray scattered;
+            color attenuation;
+            if (rec.mat_ptr->scatter(r, rec, attenuation, scattered))
+                return attenuation * rayCast(scattered, world, depth - 1);
+            return {0, 0, 0};
+        }
+        return background(r);
+    }
+
+    // diffuse_depth counts the diffuse vertices already on the path
+    [[nodiscard]] static color rayCastCached(const Ray& r, const Hittable& world, int depth, int diffuse_depth,
+                                             RadianceCache& cache)  {
+        HitRecord rec;
+        if (depth <= 0) return {0, 0, 0};
+        if (world.hit(r, 0.001, infinity, rec)) {
+            Ray scattered;
+            color attenuation;
+            if (!rec.mat_ptr->scatter(r, rec, attenuation, scattered))
+                return {0, 0, 0};
+            if (!rec.mat_ptr->isDiffuse())
+                return attenuation * rayCastCached(scattered, world, depth - 1, diffuse_depth, cache);
+
+            color incoming;
+            if (diffuse_depth >= cache.min_reuse_depth && cache.lookup(rec.p, rec.n, incoming))
+                return attenuation * incoming;
+            incoming = rayCastCached(scattered, world, depth - 1, diffuse_depth + 1, cache);
+            cache.insert(rec.p, rec.n, incoming);
+            return attenuation * incoming;
+        }
+        return background(r);
+    }
+
+    static color background(const Ray& r) {
+        Vec3 u_dir = r.dir.normalized();
+        auto t = 0.5 * (u_dir.y + 1.0);
+        return (1.0 - t) * color(1.0, 1.0, 1.0) + t * color(0.5, 0.7, 1.0);
+    }
+
+    void operator() (const tbb::blocked_range2d<int>& r) const {
+        if (cancelled && cancelled->load(std::memory_order_relaxed)) return;
+        for (int i=r.rows().begin(); i!=r.rows().end(); ++i) {
+            for (int j=r.cols().begin(); j!=r.cols().end(); ++j ) {
+                color pixel_color(0, 0, 0);
+                for (int s = 0; s < samples_per_pixel; ++s) {
+                    auto u = (i + random_double()) / (width - 1);
+                    auto v = (j + random_double()) / (height - 1);
+                    Ray ray = camera.shootRay(u, v);
+                    if (cache)
+                        pixel_color += rayCastCached(ray, scene, max_depth, 0, *cache);
+                    else
+                        pixel_color += rayCast(ray, scene, max_depth);
+                }
+                if (accumulate)
+                    image.accumulate(i, j, pixel_color);
+                else
+                    image.shade(i, j, pixel_color);
+            }
+        }
+        if (progress)
+            progress->fetch_add(static_cast<long>(r.rows().size()) * r.cols().size() * samples_per_pixel,
+                                std::memory_order_relaxed);
+    }
+};
+
+#endif //RENDERER_H
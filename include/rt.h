@@ -0,0 +1,117 @@
+#ifndef RT_H
+#define RT_H
+
+// In-process renderer API, built as the `rt` library.
+//
+// Only this header is part of the API, the renderer internals stay out of
+// it so they can change without breaking callers. Any number of renders may
+// run at the same time, from any threads, over the same or different scenes.
+//
+//     rt::Scene scene;
+//     scene.loadCanned("random");
+//     std::vector<float> rgb(400 * 266 * 3);
+//     auto render = rt::Render::start(scene, settings, rgb.data());
+//     while (!render->done()) show(render->progress());
+//     render->wait();
+
+#include <memory>
+#include <string>
+
+namespace rt {
+
+struct Vec {
+    double x, y, z;
+};
+
+enum class MaterialKind {
+    Lambertian,
+    Metal,
+    Dielectric,
+};
+
+struct MaterialDesc {
+    MaterialKind kind = MaterialKind::Lambertian;
+    Vec albedo{0.5, 0.5, 0.5};        // lambertian and metal
+    double fuzz = 0.0;                // metal
+    double index_of_refraction = 1.5; // dielectric
+};
+
+struct CameraDesc {
+    Vec look_from{13, 2, 2};
+    Vec look_at{0, 0, 0};
+    Vec vup{0, 1, 0};
+    double vfov = 20;       // vertical, in degrees
+    double aperture = 0.1;
+    double focus_distance = 0;  // 0 focuses on look_at
+};
+
+enum class AcceleratorKind {
+    List,
+    Bvh,
+    Grid,
+};
+
+struct RenderSettings {
+    int width = 400;
+    int height = 266;
+    int samples_per_pixel = 64;
+    int max_depth = 50;
+    AcceleratorKind accelerator = AcceleratorKind::Grid;
+    double cache_tolerance = 0;  // above 0 turns on the radiance cache
+};
+
+// Not safe to modify from several threads at once. Renders take a snapshot
+// when they start, so a scene may be edited or destroyed while they run.
+class Scene {
+public:
+    Scene();
+    ~Scene();
+    Scene(Scene&&) noexcept;
+    Scene& operator=(Scene&&) noexcept;
+
+    // replaces the content with a canned scene and its view, false for unknown names
+    bool loadCanned(const std::string& name);
+
+    void addSphere(const Vec& center, double radius, const MaterialDesc& material);
+    void clear();
+    size_t size() const;
+
+    void setCamera(const CameraDesc& camera);
+    const CameraDesc& camera() const;
+
+private:
+    friend class Render;
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+};
+
+// A render running in the background. The buffer holds width * height RGB
+// triples of linear radiance, rows from the top, and must outlive the
+// render. It is filled after every pass of doubling spp; read it after
+// wait(), after a cancel it holds the passes that completed.
+class Render {
+public:
+    // nullptr for settings that cannot be rendered, a degenerate camera
+    // (look_from == look_at, vfov outside (0, 180), negative aperture) or a null buffer
+    static std::unique_ptr<Render> start(const Scene& scene, const RenderSettings& settings, float* rgb);
+
+    // cancels and waits
+    ~Render();
+
+    // fraction of the samples traced so far, in [0, 1]
+    double progress() const;
+    bool done() const;
+    void cancel();
+    // blocks until finished, returns false when cancelled
+    bool wait();
+
+private:
+    struct Impl;
+    std::unique_ptr<Impl> impl;
+
+    explicit Render(std::unique_ptr<Impl> i);
+};
+
+}
+
+#endif //RT_H
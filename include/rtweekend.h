@@ -1,6 +1,7 @@
 #ifndef RTWEEKEND_H
 #define RTWEEKEND_H
 
+#include <atomic>
 #include <cmath>
 #include <limits>
 #include <memory>
@@ -19,9 +20,13 @@ inline double degrees_to_radians(double degrees) {
     return  degrees * pi / 180.0;
 }
 
+// One generator per thread so concurrent renders never share state. The
+// first thread to draw gets the default seed, keeping scenes built on the
+// main thread the same as with a single generator.
 inline double random_double() {
-    static std::uniform_real_distribution<double> distribution(0.0, 1.0);
-    static std::mt19937 generator;
+    static std::atomic<std::mt19937::result_type> next_seed{std::mt19937::default_seed};
+    thread_local std::uniform_real_distribution<double> distribution(0.0, 1.0);
+    thread_local std::mt19937 generator(next_seed++);
     return distribution(generator);
 }
 
@@ -41,7 +46,7 @@ inline Vec3 random_vec3(double min, double max) {
     );
 }
 
-Vec3 random_in_unit_sphere() {
+inline Vec3 random_in_unit_sphere() {
     while (true) {
         auto p = random_vec3(-1, 1);
         if (p.length_sqrd() >= 1) continue;
@@ -49,18 +54,18 @@ Vec3 random_in_unit_sphere() {
     }
 }
 
-Vec3 random_unit_vector() {
+inline Vec3 random_unit_vector() {
     return random_in_unit_sphere().normalized();
 }
 
-Vec3 random_in_hemisphere(const Vec3& normal) {
+inline Vec3 random_in_hemisphere(const Vec3& normal) {
     auto in_unit_sphere = random_in_unit_sphere();
     if (normal.dot(in_unit_sphere) > 0.0)
         return in_unit_sphere;
     return -in_unit_sphere;
 }
 
-Vec3 random_in_unit_disk() {
+inline Vec3 random_in_unit_disk() {
     while (true) {
         auto p = Vec3(random_double(-1, 1), random_double(-1, 1), 0);
         if (p.length_sqrd() >= 1) continue;
@@ -0,0 +1,151 @@
+#ifndef SCENE_H
+#define SCENE_H
+
+#include "rtweekend.h"
+#include "hittable_list.h"
+#include "sphere.h"
+#include "camera.h"
+#include "material.h"
+
+#include <string>
+
+struct Scene {
+    HittableList world;
+
+    // default view, used unless a caller overrides it
+    point3 look_from;
+    point3 look_at;
+    Vec3 vup;
+    double vfov;
+    double aperture;
+
+    Camera makeCamera(double aspect_ratio) const {
+        auto dist_to_focus = (look_from - look_at).length();
+        return Camera(look_from, look_at, vup, vfov, aspect_ratio, aperture, dist_to_focus);
+    }
+};
+
+inline HittableList random_scene() {
+    HittableList world;
+
+    auto ground_material = make_shared<Lambertian>(color(0.5, 0.5, 0.5));
+    world.add(make_shared<Sphere>(point3(0,-1000,0), 1000, ground_material));
+
+    for (int a = -11; a < 11; a++) {
+        for (int b = -11; b < 11; b++) {
+            auto choose_mat = random_double();
+            point3 center(a + 0.9*random_double(), 0.2, b + 0.9*random_double());
+
+            if ((center - point3(4, 0.2, 0)).length() > 0.9) {
+                shared_ptr<Material> sphere_material;
+
+                if (choose_mat < 0.8) {
+                    // diffuse
+                    auto albedo = random_vec3() * random_vec3();
+                    sphere_material = make_shared<Lambertian>(albedo);
+                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
+                } else if (choose_mat < 0.95) {
+                    // metal
+                    auto albedo = random_vec3(0.5, 1);
+                    auto fuzz = random_double(0, 0.5);
+                    sphere_material = make_shared<Metal>(albedo, fuzz);
+                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
+                } else {
+                    // glass
+                    sphere_material = make_shared<Dielectric>(1.5);
+                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
+                }
+            }
+        }
+    }
+
+    auto material1 = make_shared<Dielectric>(1.5);
+    world.add(make_shared<Sphere>(point3(0, 1, 0), 1.0, material1));
+
+    auto material2 = make_shared<Lambertian>(color(0.4, 0.2, 0.1));
+    world.add(make_shared<Sphere>(point3(-4, 1, 0), 1.0, material2));
+
+    auto material3 = make_shared<Metal>(color(0.7, 0.6, 0.5), 0.0);
+    world.add(make_shared<Sphere>(point3(4, 1, 0), 1.0, material3));
+
+    return world;
+}
+
+// ground with one sphere of each material, a cheap scene dominated by bounces
+inline HittableList three_spheres_scene() {
+    HittableList world;
+
+    auto material_ground = make_shared<Lambertian>(color(0.8, 0.8, 0.0));
+    auto material_center = make_shared<Lambertian>(color(0.1, 0.2, 0.5));
+    auto material_left   = make_shared<Dielectric>(1.5);
+    auto material_right  = make_shared<Metal>(color(0.8, 0.6, 0.2), 0.0);
+
+    world.add(make_shared<Sphere>(point3( 0.0, -100.5, -1.0), 100.0, material_ground));
+    world.add(make_shared<Sphere>(point3( 0.0,    0.0, -1.0),   0.5, material_center));
+    world.add(make_shared<Sphere>(point3(-1.0,    0.0, -1.0),   0.5, material_left));
+    world.add(make_shared<Sphere>(point3( 1.0,    0.0, -1.0),   0.5, material_right));
+
+    return world;
+}
+
+// the layout of random_scene() with bright diffuse materials only, so most
+// light arrives after several diffuse bounces
+inline HittableList diffuse_scene() {
+    HittableList world;
+
+    world.add(make_shared<Sphere>(point3(0,-1000,0), 1000, make_shared<Lambertian>(color(0.8, 0.8, 0.8))));
+
+    for (int a = -11; a < 11; a++) {
+        for (int b = -11; b < 11; b++) {
+            point3 center(a + 0.9*random_double(), 0.2, b + 0.9*random_double());
+            if ((center - point3(4, 0.2, 0)).length() > 0.9)
+                world.add(make_shared<Sphere>(center, 0.2, make_shared<Lambertian>(random_vec3(0.6, 0.9))));
+        }
+    }
+
+    world.add(make_shared<Sphere>(point3(0, 1, 0), 1.0, make_shared<Lambertian>(color(0.9, 0.9, 0.9))));
+    world.add(make_shared<Sphere>(point3(-4, 1, 0), 1.0, make_shared<Lambertian>(color(0.8, 0.6, 0.4))));
+    world.add(make_shared<Sphere>(point3(4, 1, 0), 1.0, make_shared<Lambertian>(color(0.4, 0.6, 0.8))));
+
+    return world;
+}
+
+const char* const canned_scenes[] = {
+    "random",
+    "three_spheres",
+    "diffuse",
+};
+
+// build one of the canned scenes by name, returns false for unknown names
+inline bool make_scene(const std::string& name, Scene& scene) {
+    if (name == "random") {
+        scene.world = random_scene();
+        scene.look_from = point3(13, 2, 2);
+        scene.look_at = point3(0, 0, 0);
+        scene.vup = Vec3(0, 1, 0);
+        scene.vfov = 20;
+        scene.aperture = 0.1;
+        return true;
+    }
+    if (name == "diffuse") {
+        scene.world = diffuse_scene();
+        scene.look_from = point3(13, 2, 2);
+        scene.look_at = point3(0, 0, 0);
+        scene.vup = Vec3(0, 1, 0);
+        scene.vfov = 20;
+        scene.aperture = 0.0;
+        return true;
+    }
+    if (name == "three_spheres") {
+        scene.world = three_spheres_scene();
+        scene.look_from = point3(-2, 2, 1);
+        scene.look_at = point3(0, 0, -1);
+        scene.vup = Vec3(0, 1, 0);
+        scene.vfov = 30;
+        scene.aperture = 0.0;
+        return true;
+    }
+    return false;
+}
+
+#endif //SCENE_H
@@ -15,13 +15,19 @@ public:
     virtual bool hit(
         const Ray& r, double t_min, double t_max, HitRecord& rec) const override;
 
+    virtual bool boundingBox(AABB& output_box) const override {
+        auto rv = Vec3(radius, radius, radius);
+        output_box = AABB(center - rv, center + rv);
+        return true;
+    }
+
 public:
     Vec3 center;
     double radius;
     shared_ptr<Material> mat_ptr;
 };
 
-bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
+inline bool Sphere::hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const {
     Vec3 oc = r.origin - center;
     auto a = r.dir.length_sqrd();
     auto half_b = oc.dot(r.dir);
@@ -0,0 +1,33 @@
+#include <iostream>
+#include "radiance_cache.h"
+
+using std::cout;
+using std::endl;
+
+// distinct cells along one axis must all get a slot
+int fill_along(int axis, int cells) {
+    RadianceCache cache(0.1);
+    for (int i = 0; i < cells; ++i) {
+        point3 p(0.05, 0.05, 0.05);
+        p[axis] += i * 0.1;
+        cache.insert(p, Vec3(0, 1, 0), color(1, 1, 1));
+    }
+    cout << "axis " << axis << ": " << cache.size() << " of " << cells << " cells" << endl;
+    return cache.size() == static_cast<size_t>(cells) ? 0 : 1;
+}
+
+int main() {
+    int failed = 0;
+    for (int axis = 0; axis < 3; ++axis)
+        failed += fill_along(axis, 200);
+
+    RadianceCache cache(0.1, 4, 1.0);
+    color radiance;
+    for (int i = 0; i < 4; ++i)
+        cache.insert(point3(1, 2, 3), Vec3(0, 0, -1), color(0.5, 0.5, 0.5));
+    bool found = cache.lookup(point3(1.01, 2.01, 3.01), Vec3(0, 0, -1), radiance);
+    cout << "lookup: " << found << " " << radiance << endl;
+    if (!found || radiance != color(0.5, 0.5, 0.5)) failed++;
+
+    return failed;
+}
@@ -0,0 +1,63 @@
+#include <cmath>
+#include <iostream>
+#include <vector>
+#include "rt.h"
+
+using std::cout;
+using std::endl;
+
+int count_nan(const std::vector<float>& rgb) {
+    int nan = 0;
+    for (auto v : rgb)
+        if (std::isnan(v)) nan++;
+    return nan;
+}
+
+int main() {
+    int failed = 0;
+
+    rt::Scene scene;
+    if (!scene.loadCanned("random")) {
+        cout << "cannot load random" << endl;
+        return 1;
+    }
+
+    rt::RenderSettings settings;
+    settings.width = 60;
+    settings.height = 40;
+    settings.samples_per_pixel = 16;
+    std::vector<float> first(60 * 40 * 3), second(60 * 40 * 3), third(60 * 40 * 3);
+
+    // two renders over the same scene at once, a third one too long to finish
+    auto a = rt::Render::start(scene, settings, first.data());
+    settings.accelerator = rt::AcceleratorKind::Bvh;
+    auto b = rt::Render::start(scene, settings, second.data());
+    settings.samples_per_pixel = 100000;
+    auto c = rt::Render::start(scene, settings, third.data());
+    if (!a || !b || !c) {
+        cout << "start failed" << endl;
+        return 1;
+    }
+    c->cancel();
+
+    bool wa = a->wait(), wb = b->wait(), wc = c->wait();
+    cout << "wait: " << wa << " " << wb << " " << wc << endl;
+    if (!wa || !wb || wc) failed++;
+
+    cout << "progress: " << a->progress() << " " << b->progress() << endl;
+    if (a->progress() != 1 || b->progress() != 1) failed++;
+
+    int nan = count_nan(first) + count_nan(second) + count_nan(third);
+    cout << "nan: " << nan << endl;
+    if (nan) failed++;
+
+    // a camera looking at its own position has no view direction
+    auto camera = scene.camera();
+    camera.look_at = camera.look_from;
+    scene.setCamera(camera);
+    bool refused = !rt::Render::start(scene, settings, first.data());
+    cout << "degenerate camera refused: " << refused << endl;
+    if (!refused) failed++;
+
+    return failed;
+}
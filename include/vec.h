@@ -25,6 +25,10 @@ public:
 
   Vec3 operator-() const { return Vec3(-x, -y, -z); }
 
+  double operator[](int i) const { return i == 0 ? x : (i == 1 ? y : z); }
+
+  double &operator[](int i) { return i == 0 ? x : (i == 1 ? y : z); }
+
   Vec3 &operator+=(const Vec3 &v) {
     x += v.x;
     y += v.y;
@@ -69,35 +73,35 @@ public:
   }
 };
 
-std::ostream &operator<<(std::ostream &out, const Vec3 &v) {
+inline std::ostream &operator<<(std::ostream &out, const Vec3 &v) {
   return out << v.x << " " << v.y << " " << v.z;
 }
 
-Vec3 operator+(const Vec3 &u, const Vec3 &v) {
+inline Vec3 operator+(const Vec3 &u, const Vec3 &v) {
   return Vec3(u.x + v.x, u.y + v.y, u.z + v.z);
 }
 
-Vec3 operator-(const Vec3 &u, const Vec3 &v) {
+inline Vec3 operator-(const Vec3 &u, const Vec3 &v) {
   return Vec3(u.x - v.x, u.y - v.y, u.z - v.z);
 }
 
-Vec3 operator*(const Vec3 &u, const Vec3 &v) {
+inline Vec3 operator*(const Vec3 &u, const Vec3 &v) {
   return Vec3(u.x * v.x, u.y * v.y, u.z * v.z);
 }
 
-Vec3 operator*(const Vec3 &u, double t) {
+inline Vec3 operator*(const Vec3 &u, double t) {
   return Vec3(u.x * t, u.y * t, u.z * t);
 }
 
-Vec3 operator/(const Vec3 &u, double t) { return u * (1 / t); }
+inline Vec3 operator/(const Vec3 &u, double t) { return u * (1 / t); }
 
-Vec3 operator*(double t, const Vec3 &u) { return u * t; }
+inline Vec3 operator*(double t, const Vec3 &u) { return u * t; }
 
-Vec3 reflect(const Vec3& v, const Vec3& n) {
+inline Vec3 reflect(const Vec3& v, const Vec3& n) {
     return (v - 2 * v.dot(n) * n);
 }
 
-Vec3 refract(const Vec3& uv, const Vec3& n, double etai_over_etat) {
+inline Vec3 refract(const Vec3& uv, const Vec3& n, double etai_over_etat) {
     auto cos_theta = fmin(n.dot(-uv), 1.0);
     Vec3 r_out_perp =  etai_over_etat * (uv + cos_theta*n);
     Vec3 r_out_parallel = -sqrt(fabs(1.0 - r_out_perp.length_sqrd())) * n;
@@ -0,0 +1,102 @@
+// Builds every accelerator over a canned scene and renders the same frame
+// with each of them.
+//
+//   accel_bench [scene=random] [width=300] [spp=4] [depth=50]
+//
+// Prints build time, render time, traced rays per second and how many
+// primary rays disagree with the brute force list on the closest hit.
+
+#include "rtweekend.h"
+#include "scene.h"
+#include "accelerators.h"
+#include "renderer.h"
+#include "ppm.h"
+#include "camera.h"
+
+#include <tbb/tbb.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std::chrono;
+
+// counts the rays traced through the wrapped structure
+class CountingHittable : public Hittable {
+public:
+    explicit CountingHittable(const Hittable& h) : inner(h) {}
+
+    virtual bool hit(const Ray& r, double t_min, double t_max, HitRecord& rec) const override {
+        rays.local()++;
+        return inner.hit(r, t_min, t_max, rec);
+    }
+
+    virtual bool boundingBox(AABB& output_box) const override {
+        return inner.boundingBox(output_box);
+    }
+
+    long total() const {
+        return rays.combine([](long a, long b) { return a + b; });
+    }
+
+private:
+    const Hittable& inner;
+    mutable tbb::combinable<long> rays{[] { return 0L; }};
+};
+
+int main(int argc, char** argv) {
+    std::string scene_name = argc > 1 ? argv[1] : "random";
+    const int image_width = argc > 2 ? std::atoi(argv[2]) : 300;
+    const int samples_per_pixel = argc > 3 ? std::atoi(argv[3]) : 4;
+    const int max_depth = argc > 4 ? std::atoi(argv[4]) : 50;
+
+    auto aspect_ratio = 3.0 / 2.0;
+    const int image_height = image_width / aspect_ratio;
+    if (image_width < 2 || image_height < 2 || samples_per_pixel < 1 || max_depth < 1) {
+        std::cerr << "bad arguments\n";
+        return 1;
+    }
+
+    Scene scene;
+    if (!make_scene(scene_name, scene)) {
+        std::cerr << "unknown scene " << scene_name << "\n";
+        return 1;
+    }
+
+    Camera camera = scene.makeCamera(aspect_ratio);
+
+    // fixed primary rays for the agreement check
+    std::vector<Ray> probes;
+    for (int j = 0; j < image_height; ++j)
+        for (int i = 0; i < image_width; ++i)
+            probes.push_back(camera.shootRay((i + 0.5) / (image_width - 1), (j + 0.5) / (image_height - 1)));
+    ListAccelerator reference(scene.world.getObjects());
+
+    std::printf("%-6s %10s %10s %12s %10s\n", "accel", "build_ms", "render_ms", "Mrays/s", "mismatch");
+    for (auto type : all_accelerators) {
+        auto start = steady_clock::now();
+        auto accel = make_accelerator(type, scene.world);
+        auto build_ms = duration<double, std::milli>(steady_clock::now() - start).count();
+
+        int mismatch = 0;
+        for (const auto& ray : probes) {
+            HitRecord a, b;
+            bool ha = accel->hit(ray, 0.001, infinity, a);
+            bool hb = reference.hit(ray, 0.001, infinity, b);
+            if (ha != hb || (ha && std::fabs(a.t - b.t) > 1e-9)) mismatch++;
+        }
+
+        CountingHittable counted(*accel);
+        PPM image(image_width, image_height, samples_per_pixel);
+        tbb_shading shading(image, camera, counted, image_width, image_height, samples_per_pixel, max_depth);
+        shading.accumulate = true;
+
+        start = steady_clock::now();
+        tbb::parallel_for(tbb::blocked_range2d<int>(0, image_width, 0, image_height), shading);
+        auto render_s = duration<double>(steady_clock::now() - start).count();
+
+        std::printf("%-6s %10.2f %10.1f %12.3f %10d\n", accel->name(), build_ms, render_s * 1000,
+                    counted.total() / render_s / 1e6, mismatch);
+    }
+    return 0;
+}
@@ -0,0 +1,95 @@
+// Renders an animation over a scene with keyframed spheres.
+//
+//   rt_animate [frames=24] [width=300] [spp=8] [max_growth=2.0] [mode=refit]
+//
+// mode refit keeps one BVH alive, refits it every frame and rebuilds the
+// subtrees whose surface area grew past max_growth times their built area.
+// mode rebuild builds a fresh BVH every frame, for comparison.
+// Writes frame_000.ppm ... and prints per frame timings as CSV on stdout.
+
+#include "rtweekend.h"
+#include "animation.h"
+#include "bvh.h"
+#include "renderer.h"
+#include "ppm.h"
+#include "camera.h"
+
+#include <tbb/tbb.h>
+#include <chrono>
+#include <cstdio>
+#include <iostream>
+#include <string>
+
+using namespace std::chrono;
+
+static double ms_since(steady_clock::time_point start) {
+    return duration<double, std::milli>(steady_clock::now() - start).count();
+}
+
+int main(int argc, char** argv) {
+    const int frames = argc > 1 ? std::atoi(argv[1]) : 24;
+    const int image_width = argc > 2 ? std::atoi(argv[2]) : 300;
+    const int samples_per_pixel = argc > 3 ? std::atoi(argv[3]) : 8;
+    const double max_growth = argc > 4 ? std::atof(argv[4]) : 2.0;
+    const std::string mode = argc > 5 ? argv[5] : "refit";
+    const int max_depth = 50;
+    if (mode != "refit" && mode != "rebuild") {
+        std::cerr << "unknown mode " << mode << "\n";
+        return 1;
+    }
+
+    auto aspect_ratio = 3.0 / 2.0;
+    const int image_height = image_width / aspect_ratio;
+    if (image_width < 2 || image_height < 2 || samples_per_pixel < 1 || frames < 1 || max_growth <= 0) {
+        std::cerr << "bad arguments\n";
+        return 1;
+    }
+
+    AnimatedScene animated;
+    make_animated_scene("random", animated);
+
+    Camera camera = animated.scene.makeCamera(aspect_ratio);
+
+    animated.setTime(0);
+    auto bvh = make_shared<Bvh>(animated.scene.world.getObjects());
+
+    std::printf("frame,update_ms,refit_ms,rebuild_ms,rebuilt_subtrees,render_ms\n");
+    for (int f = 0; f < frames; ++f) {
+        auto start = steady_clock::now();
+        animated.setTime(frames > 1 ? f / double(frames - 1) : 0.0);
+        auto update_ms = ms_since(start);
+
+        double refit_ms = 0;
+        double rebuild_ms = 0;
+        int rebuilt = 0;
+        if (mode == "refit") {
+            start = steady_clock::now();
+            bvh->refit();
+            refit_ms = ms_since(start);
+
+            start = steady_clock::now();
+            rebuilt = bvh->rebuildDegraded(max_growth);
+            rebuild_ms = ms_since(start);
+        } else {
+            start = steady_clock::now();
+            bvh = make_shared<Bvh>(animated.scene.world.getObjects());
+            rebuild_ms = ms_since(start);
+            rebuilt = 1;
+        }
+
+        start = steady_clock::now();
+        PPM image(image_width, image_height, samples_per_pixel);
+        tbb_shading shading(image, camera, *bvh, image_width, image_height, samples_per_pixel, max_depth);
+        shading.accumulate = true;
+        tbb::parallel_for(tbb::blocked_range2d<int>(0, image_width, 0, image_height), shading);
+        auto render_ms = ms_since(start);
+
+        char file_name[32];
+        std::snprintf(file_name, sizeof(file_name), "frame_%03d.ppm", f);
+        image.write_to_file(file_name);
+
+        std::printf("%d,%.3f,%.3f,%.3f,%d,%.1f\n", f, update_ms, refit_ms, rebuild_ms, rebuilt, render_ms);
+        std::fflush(stdout);
+    }
+    return 0;
+}
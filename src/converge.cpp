@@ -0,0 +1,173 @@
+// Equal-time convergence benchmark.
+//
+//   rt_converge [width=160] [reference_spp=1024] [budgets=0.25,0.5,1,2] [scenes=random,three_spheres]
+//
+// For every scene a high spp reference is rendered first. Every candidate
+// configuration then renders the same frame one spp pass at a time, and
+// whenever the elapsed time (acceleration structure build included, radiance
+// cache table allocation excluded) crosses a budget its error against the
+// reference is reported. Output is CSV on stdout:
+//
+//   scene,config,budget_s,time_s,spp,rmse,relmse,reference_limited
+//
+// Errors are measured on linear radiance, before gamma and clamping. Once a
+// candidate reaches a quarter of the reference spp the reference noise makes
+// up a fifth or more of the measured MSE; such rows have reference_limited
+// set to 1 and should be rerun with a larger reference_spp.
+
+#include "rtweekend.h"
+#include "scene.h"
+#include "accelerators.h"
+#include "renderer.h"
+#include "ppm.h"
+#include "camera.h"
+
+#include <tbb/tbb.h>
+#include <algorithm>
+#include <chrono>
+#include <cmath>
+#include <cstdio>
+#include <iostream>
+#include <memory>
+#include <sstream>
+#include <string>
+#include <vector>
+
+using namespace std::chrono;
+
+struct Candidate {
+    std::string name;
+    AcceleratorType accel;
+    int max_depth;
+    double cache_tolerance;  // 0 renders without the radiance cache
+};
+
+const Candidate candidates[] = {
+    {"list", AcceleratorType::List, 50, 0},
+    {"bvh", AcceleratorType::Bvh, 50, 0},
+    {"grid", AcceleratorType::Grid, 50, 0},
+    {"grid_depth8", AcceleratorType::Grid, 8, 0},
+    {"grid_cache0.1", AcceleratorType::Grid, 50, 0.1},
+    {"grid_cache0.3", AcceleratorType::Grid, 50, 0.3},
+};
+
+struct ImageError {
+    double rmse;
+    double relmse;
+};
+
+static ImageError compare(const PPM& image, const PPM& reference) {
+    // keeps relMSE finite on black reference pixels
+    const double eps = 1e-2;
+    double se = 0, rel = 0;
+    for (int i = 0; i < image.width; ++i) {
+        for (int j = 0; j < image.height; ++j) {
+            auto c = image.ppm[i][j] / image.samples_per_pixel;
+            auto r = reference.ppm[i][j] / reference.samples_per_pixel;
+            for (int a = 0; a < 3; ++a) {
+                auto d = c[a] - r[a];
+                se += d * d;
+                rel += d * d / (r[a] * r[a] + eps);
+            }
+        }
+    }
+    auto n = 3.0 * image.width * image.height;
+    return {std::sqrt(se / n), rel / n};
+}
+
+static std::vector<std::string> split(const std::string& s) {
+    std::vector<std::string> parts;
+    std::istringstream in(s);
+    std::string part;
+    while (std::getline(in, part, ','))
+        if (!part.empty()) parts.push_back(part);
+    return parts;
+}
+
+int main(int argc, char** argv) {
+    const int image_width = argc > 1 ? std::atoi(argv[1]) : 160;
+    const int reference_spp = argc > 2 ? std::atoi(argv[2]) : 1024;
+    std::vector<double> budgets;
+    for (const auto& b : split(argc > 3 ? argv[3] : "0.25,0.5,1,2"))
+        budgets.push_back(std::atof(b.c_str()));
+    std::vector<std::string> scene_names;
+    if (argc > 4)
+        scene_names = split(argv[4]);
+    else
+        scene_names.assign(std::begin(canned_scenes), std::end(canned_scenes));
+    std::sort(budgets.begin(), budgets.end());
+
+    auto aspect_ratio = 3.0 / 2.0;
+    const int image_height = image_width / aspect_ratio;
+    if (budgets.empty() || image_width < 2 || image_height < 2 || reference_spp < 1) {
+        std::cerr << "bad arguments\n";
+        return 1;
+    }
+    tbb::blocked_range2d<int> frame(0, image_width, 0, image_height);
+
+    std::printf("scene,config,budget_s,time_s,spp,rmse,relmse,reference_limited\n");
+    for (const auto& scene_name : scene_names) {
+        Scene scene;
+        if (!make_scene(scene_name, scene)) {
+            std::cerr << "unknown scene " << scene_name << "\n";
+            return 1;
+        }
+        Camera camera = scene.makeCamera(aspect_ratio);
+
+        std::cerr << "rendering reference for " << scene_name << "\n";
+        auto reference_accel = make_accelerator(AcceleratorType::Grid, scene.world);
+        PPM reference(image_width, image_height, reference_spp);
+        tbb_shading reference_shading(reference, camera, *reference_accel, image_width, image_height,
+                                      reference_spp, 50);
+        reference_shading.accumulate = true;
+        tbb::parallel_for(frame, reference_shading);
+
+        for (const auto& candidate : candidates) {
+            // the first pass only fills the cache, later ones reuse it. Its
+            // table is allocated outside the timing, a server would reuse it
+            std::unique_ptr<RadianceCache> cache;
+            if (candidate.cache_tolerance > 0) {
+                cache = std::make_unique<RadianceCache>();
+                cache->tolerance = candidate.cache_tolerance;
+                cache->populating = true;
+            }
+
+            auto start = steady_clock::now();
+            auto accel = make_accelerator(candidate.accel, scene.world);
+
+            PPM image(image_width, image_height, 0);
+            tbb_shading shading(image, camera, *accel, image_width, image_height, 1, candidate.max_depth);
+            shading.accumulate = true;
+            shading.cache = cache.get();
+
+            size_t next_budget = 0;
+            bool warned = false;
+            while (next_budget < budgets.size()) {
+                tbb::parallel_for(frame, shading);
+                image.samples_per_pixel++;
+                if (cache) cache->populating = false;
+
+                auto elapsed = duration<double>(steady_clock::now() - start).count();
+                if (elapsed < budgets[next_budget]) continue;
+
+                auto error = compare(image, reference);
+                bool reference_limited = 4 * image.samples_per_pixel >= reference_spp;
+                if (reference_limited && !warned) {
+                    std::cerr << "warning: " << scene_name << "," << candidate.name << " reached "
+                              << image.samples_per_pixel << " spp against a " << reference_spp
+                              << " spp reference, its error is limited by reference noise\n";
+                    warned = true;
+                }
+                // a slow pass may cross several budgets at once
+                while (next_budget < budgets.size() && elapsed >= budgets[next_budget]) {
+                    std::printf("%s,%s,%g,%.4f,%d,%.6g,%.6g,%d\n", scene_name.c_str(), candidate.name.c_str(),
+                                budgets[next_budget], elapsed, image.samples_per_pixel,
+                                error.rmse, error.relmse, reference_limited ? 1 : 0);
+                    next_budget++;
+                }
+                std::fflush(stdout);
+            }
+        }
+    }
+    return 0;
+}
@@ -1,124 +1,36 @@
 #include "rtweekend.h"
-#include "hittable_list.h"
-#include "sphere.h"
+#include "scene.h"
+#include "accelerators.h"
+#include "renderer.h"
 #include "ppm.h"
 #include "camera.h"
-#include "material.h"
 
 #include <tbb/tbb.h>
 #include <iostream>
+#include <memory>
 
 using namespace tbb::detail::d1;
 using namespace std::chrono;
 
-HittableList random_scene() {
-    HittableList world;
-
-    auto ground_material = make_shared<Lambertian>(color(0.5, 0.5, 0.5));
-    world.add(make_shared<Sphere>(point3(0,-1000,0), 1000, ground_material));
-
-    for (int a = -11; a < 11; a++) {
-        for (int b = -11; b < 11; b++) {
-            auto choose_mat = random_double();
-            point3 center(a + 0.9*random_double(), 0.2, b + 0.9*random_double());
-
-            if ((center - point3(4, 0.2, 0)).length() > 0.9) {
-                shared_ptr<Material> sphere_material;
-
-                if (choose_mat < 0.8) {
-                    // diffuse
-                    auto albedo = random_vec3() * random_vec3();
-                    sphere_material = make_shared<Lambertian>(albedo);
-                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
-                } else if (choose_mat < 0.95) {
-                    // metal
-                    auto albedo = random_vec3(0.5, 1);
-                    auto fuzz = random_double(0, 0.5);
-                    sphere_material = make_shared<Metal>(albedo, fuzz);
-                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
-                } else {
-                    // glass
-                    sphere_material = make_shared<Dielectric>(1.5);
-                    world.add(make_shared<Sphere>(center, 0.2, sphere_material));
-                }
-            }
-        }
-    }
-
-    auto material1 = make_shared<Dielectric>(1.5);
-    world.add(make_shared<Sphere>(point3(0, 1, 0), 1.0, material1));
-
-    auto material2 = make_shared<Lambertian>(color(0.4, 0.2, 0.1));
-    world.add(make_shared<Sphere>(point3(-4, 1, 0), 1.0, material2));
-
-    auto material3 = make_shared<Metal>(color(0.7, 0.6, 0.5), 0.0);
-    world.add(make_shared<Sphere>(point3(4, 1, 0), 1.0, material3));
-
-    return world;
-}
-
-struct tbb_shading{
-    PPM& image;
-    Camera& camera;
-    HittableList& scene;
-
-    int width;
-    int height;
-    int samples_per_pixel;
-    int max_depth;
-
-    tbb_shading(PPM& p, Camera& c, HittableList& s, int w, int h, int sp, int m)
-        : image(p)
-        , camera(c)
-        , scene(s)
-        , width(w)
-        , height(h)
-        , samples_per_pixel(sp)
-        , max_depth(m){
-
-    }
-
-    [[nodiscard]] static color rayCast(const Ray& r, const HittableList& world, int depth)  {
-        HitRecord rec;
-        if (depth <= 0) return {0, 0, 0};
-        if (world.hit(r, 0.001, infinity, rec)) {
-            Ray scattered;
-            color attenuation;
-            if (rec.mat_ptr->scatter(r, rec, attenuation, scattered))
-                return attenuation * rayCast(scattered, world, depth - 1);
-            return {0, 0, 0};
-        }
-        Vec3 u_dir = r.dir.normalized();
-        auto t = 0.5 * (u_dir.y + 1.0);
-        return (1.0 - t) * color(1.0, 1.0, 1.0) + t * color(0.5, 0.7, 1.0);
+int main(int argc, char** argv) {
+    // construct world
+    Scene scene;
+    make_scene("random", scene);
+
+    // list, bvh or grid
+    AcceleratorType accel_type = AcceleratorType::Grid;
+    if (argc > 1 && !parse_accelerator(argv[1], accel_type)) {
+        std::cerr << "unknown accelerator " << argv[1] << "\n";
+        return 1;
     }
+    auto world = make_accelerator(accel_type, scene.world);
 
-    void operator() (const blocked_range2d<int>& r) const {
-        for (int i=r.rows().begin(); i!=r.rows().end(); ++i) {
-            for (int j=r.cols().begin(); j!=r.cols().end(); ++j ) {
-                color pixel_color(0, 0, 0);
-                for (int s = 0; s < samples_per_pixel; ++s) {
-                    auto u = (i + random_double()) / (width - 1);
-                    auto v = (j + random_double()) / (height - 1);
-                    Ray ray = camera.shootRay(u, v);
-                    pixel_color += rayCast(ray, scene, max_depth);
-                }
-                image.shade(i, j, pixel_color);
-            }
-        }
-    }
-};
+    // a tolerance turns on the radiance cache, lower is closer to unbiased
+    double cache_tolerance = argc > 2 ? std::atof(argv[2]) : 0.0;
 
-int main() {
     // construct camera
-    point3 lookFrom(13,2,2);
-    point3 lookAt(0,0,0);
-    Vec3 vup(0,1,0);
-    auto dist_to_focus = (lookFrom-lookAt).length();
-    auto aperture = 0.1;
     auto aspect_ratio = 3.0 / 2.0;
-
-    Camera camera(lookFrom, lookAt, vup, 20, aspect_ratio, aperture, dist_to_focus);
+    Camera camera = scene.makeCamera(aspect_ratio);
 
     // prepare frame
     const int image_width = 1200;
@@ -126,15 +38,28 @@ int main() {
     const int samples_per_pixel = 500;
     const int max_depth = 50;
 
-    // construct world
-    HittableList world = random_scene();
-
     // construct image
     PPM image(image_width, image_height, samples_per_pixel);
 
+    tbb_shading shading(image, camera, *world, image_width, image_height, samples_per_pixel, max_depth);
+    std::unique_ptr<RadianceCache> cache;
+    if (cache_tolerance > 0) {
+        cache = std::make_unique<RadianceCache>();
+        cache->tolerance = cache_tolerance;
+
+        // fill the cache with a throwaway one sample pass
+        PPM scratch(image_width, image_height, 1);
+        tbb_shading populate(scratch, camera, *world, image_width, image_height, 1, max_depth);
+        populate.accumulate = true;
+        populate.cache = cache.get();
+        cache->populating = true;
+        parallel_for(blocked_range2d<int>(0, image_width, 0, image_height), populate);
+        cache->populating = false;
+        shading.cache = cache.get();
+    }
+
     // tbb accelerate
-    parallel_for(blocked_range2d<int>(0, image_width, 0, image_height),
-            tbb_shading(image, camera, world, image_width, image_height, samples_per_pixel, max_depth));
+    parallel_for(blocked_range2d<int>(0, image_width, 0, image_height), shading);
 
 
     image.write_to_file();
@@ -0,0 +1,241 @@
+#include "rt.h"
+
+#include "rtweekend.h"
+#include "scene.h"
+#include "accelerators.h"
+#include "renderer.h"
+#include "radiance_cache.h"
+#include "material.h"
+#include "sphere.h"
+#include "ppm.h"
+#include "camera.h"
+
+#include <tbb/tbb.h>
+#include <algorithm>
+#include <atomic>
+#include <mutex>
+#include <thread>
+
+namespace rt {
+
+static Vec3 to_vec3(const Vec& v) {
+    return Vec3(v.x, v.y, v.z);
+}
+
+static Vec to_vec(const Vec3& v) {
+    return Vec{v.x, v.y, v.z};
+}
+
+static AcceleratorType to_accelerator_type(AcceleratorKind kind) {
+    switch (kind) {
+    case AcceleratorKind::List:
+        return AcceleratorType::List;
+    case AcceleratorKind::Bvh:
+        return AcceleratorType::Bvh;
+    default:
+        return AcceleratorType::Grid;
+    }
+}
+
+static shared_ptr<Material> make_material(const MaterialDesc& desc) {
+    switch (desc.kind) {
+    case MaterialKind::Metal:
+        return make_shared<Metal>(to_vec3(desc.albedo), desc.fuzz);
+    case MaterialKind::Dielectric:
+        return make_shared<Dielectric>(desc.index_of_refraction);
+    default:
+        return make_shared<Lambertian>(to_vec3(desc.albedo));
+    }
+}
+
+struct Scene::Impl {
+    HittableList world;
+    size_t count = 0;
+    CameraDesc camera;
+
+    // acceleration structure of the current content, shared by the renders
+    // started until the next edit
+    std::mutex accel_mutex;
+    shared_ptr<Accelerator> accel;
+    AcceleratorKind accel_kind = AcceleratorKind::Grid;
+
+    void edited() {
+        std::lock_guard<std::mutex> lock(accel_mutex);
+        accel = nullptr;
+    }
+
+    shared_ptr<Accelerator> snapshot(AcceleratorKind kind) {
+        std::lock_guard<std::mutex> lock(accel_mutex);
+        if (!accel || accel_kind != kind) {
+            accel = make_accelerator(to_accelerator_type(kind), world);
+            accel_kind = kind;
+        }
+        return accel;
+    }
+};
+
+Scene::Scene() : impl(std::make_unique<Impl>()) {}
+
+Scene::~Scene() = default;
+
+Scene::Scene(Scene&&) noexcept = default;
+
+Scene& Scene::operator=(Scene&&) noexcept = default;
+
+bool Scene::loadCanned(const std::string& name) {
+    ::Scene canned;
+    if (!make_scene(name, canned)) return false;
+
+    impl->world = canned.world;
+    impl->count = canned.world.getObjects().size();
+    impl->camera.look_from = to_vec(canned.look_from);
+    impl->camera.look_at = to_vec(canned.look_at);
+    impl->camera.vup = to_vec(canned.vup);
+    impl->camera.vfov = canned.vfov;
+    impl->camera.aperture = canned.aperture;
+    impl->camera.focus_distance = 0;
+    impl->edited();
+    return true;
+}
+
+void Scene::addSphere(const Vec& center, double radius, const MaterialDesc& material) {
+    impl->world.add(make_shared<Sphere>(to_vec3(center), radius, make_material(material)));
+    impl->count++;
+    impl->edited();
+}
+
+void Scene::clear() {
+    impl->world.clear();
+    impl->count = 0;
+    impl->edited();
+}
+
+size_t Scene::size() const {
+    return impl->count;
+}
+
+void Scene::setCamera(const CameraDesc& camera) {
+    impl->camera = camera;
+}
+
+const CameraDesc& Scene::camera() const {
+    return impl->camera;
+}
+
+struct Render::Impl {
+    shared_ptr<Accelerator> accel;
+    Camera camera;
+    RenderSettings settings;
+    float* rgb;
+    std::unique_ptr<RadianceCache> cache;
+
+    std::atomic<bool> cancelled{false};
+    std::atomic<bool> finished{false};
+    bool completed = false;
+    std::atomic<long> traced{0};
+
+    std::mutex join_mutex;
+    std::thread worker;
+
+    void run() {
+        const int width = settings.width;
+        const int height = settings.height;
+        PPM image(width, height, 0);
+        tbb::blocked_range2d<int> frame(0, width, 0, height);
+
+        int done = 0;
+        int pass = 1;
+        while (done < settings.samples_per_pixel && !cancelled) {
+            int spp = std::min(pass, settings.samples_per_pixel - done);
+            tbb_shading shading(image, camera, *accel, width, height, spp, settings.max_depth);
+            shading.accumulate = true;
+            shading.cancelled = &cancelled;
+            shading.progress = &traced;
+            shading.cache = cache.get();
+            tbb::parallel_for(frame, shading);
+            // the first pass also fills the cache, later ones may reuse it
+            if (cache) cache->populating = false;
+            if (cancelled) break;
+
+            done += spp;
+            pass *= 2;
+            publish(image, done);
+        }
+
+        completed = done == settings.samples_per_pixel;
+        finished = true;
+    }
+
+    void publish(const PPM& image, int samples) {
+        const int width = settings.width;
+        const int height = settings.height;
+        for (int row = 0; row < height; ++row) {
+            float* out = rgb + static_cast<size_t>(row) * width * 3;
+            for (int i = 0; i < width; ++i) {
+                auto c = image.ppm[i][height - 1 - row] / samples;
+                out[3 * i + 0] = static_cast<float>(c.x);
+                out[3 * i + 1] = static_cast<float>(c.y);
+                out[3 * i + 2] = static_cast<float>(c.z);
+            }
+        }
+    }
+};
+
+std::unique_ptr<Render> Render::start(const Scene& scene, const RenderSettings& settings, float* rgb) {
+    if (!rgb || settings.width < 2 || settings.height < 2 || settings.samples_per_pixel < 1
+        || settings.max_depth < 1 || settings.cache_tolerance < 0)
+        return nullptr;
+    const auto& cam = scene.camera();
+    auto from = to_vec3(cam.look_from);
+    auto at = to_vec3(cam.look_at);
+    if (from == at || !(cam.vfov > 0 && cam.vfov < 180) || cam.aperture < 0)
+        return nullptr;
+
+    auto impl = std::make_unique<Impl>();
+    impl->accel = scene.impl->snapshot(settings.accelerator);
+    impl->settings = settings;
+    impl->rgb = rgb;
+
+    auto focus = cam.focus_distance > 0 ? cam.focus_distance : (from - at).length();
+    impl->camera = Camera(from, at, to_vec3(cam.vup), cam.vfov,
+                          double(settings.width) / settings.height, cam.aperture, focus);
+
+    if (settings.cache_tolerance > 0) {
+        impl->cache = std::make_unique<RadianceCache>();
+        impl->cache->tolerance = settings.cache_tolerance;
+        impl->cache->populating = true;
+    }
+
+    Impl* running = impl.get();
+    impl->worker = std::thread([running] { running->run(); });
+    return std::unique_ptr<Render>(new Render(std::move(impl)));
+}
+
+Render::Render(std::unique_ptr<Impl> i) : impl(std::move(i)) {}
+
+Render::~Render() {
+    cancel();
+    wait();
+}
+
+double Render::progress() const {
+    auto total = static_cast<double>(impl->settings.width) * impl->settings.height
+                 * impl->settings.samples_per_pixel;
+    return std::min(1.0, impl->traced.load(std::memory_order_relaxed) / total);
+}
+
+bool Render::done() const {
+    return impl->finished;
+}
+
+void Render::cancel() {
+    impl->cancelled = true;
+}
+
+bool Render::wait() {
+    std::lock_guard<std::mutex> lock(impl->join_mutex);
+    if (impl->worker.joinable()) impl->worker.join();
+    return impl->completed;
+}
+
+}
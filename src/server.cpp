@@ -0,0 +1,341 @@
+// Long-running render server.
+//
+// Jobs are read line by line from stdin (pipe a local socket in with e.g.
+// `socat UNIX-LISTEN:/tmp/rt.sock,fork EXEC:./rt_server` when needed),
+// replies are written line by line to stdout.
+//
+//   load <scene_id> [scene=random] [accel=grid]
+//   unload <scene_id>
+//   render <job_id> scene=<scene_id> [width=400] [spp=64] [depth=50]
+//          [out=<job_id>.ppm] [priority=low|normal|high] [aspect=1.5]
+//          [from=x,y,z] [at=x,y,z] [fov=deg] [aperture=a]
+//   cancel <job_id>
+//   quit
+//
+//   loaded <scene_id> <ms>
+//   queued <job_id>
+//   progress <job_id> <spp_done> <spp_total> <path>
+//   done <job_id> <ms>
+//   cancelled <job_id>
+//   error <message>
+//
+// Scenes and their acceleration structure stay resident until unloaded, a
+// render naming a scene that is not loaded yet loads the canned scene of
+// that name. Each job is rendered in passes of doubling spp and the image is
+// rewritten after every pass.
+
+#include "rtweekend.h"
+#include "scene.h"
+#include "accelerators.h"
+#include "renderer.h"
+#include "ppm.h"
+#include "camera.h"
+
+#include <tbb/tbb.h>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <condition_variable>
+#include <fstream>
+#include <iostream>
+#include <map>
+#include <mutex>
+#include <queue>
+#include <sstream>
+#include <string>
+#include <thread>
+#include <unordered_map>
+#include <vector>
+
+using namespace std::chrono;
+
+struct ResidentScene {
+    Scene scene;
+    shared_ptr<Accelerator> accel;
+};
+
+struct RenderJob {
+    std::string id;
+    shared_ptr<const ResidentScene> resident;
+    int width = 400;
+    int samples_per_pixel = 64;
+    int max_depth = 50;
+    double aspect_ratio = 3.0 / 2.0;
+    std::string output;
+    int priority = 1;
+    long sequence = 0;
+
+    point3 look_from;
+    point3 look_at;
+    double vfov = 20;
+    double aperture = 0.1;
+
+    std::atomic<bool> cancelled{false};
+};
+
+struct JobOrder {
+    bool operator()(const shared_ptr<RenderJob>& a, const shared_ptr<RenderJob>& b) const {
+        // higher priority first, FIFO within the same priority
+        if (a->priority != b->priority) return a->priority < b->priority;
+        return a->sequence > b->sequence;
+    }
+};
+
+class RenderServer {
+public:
+    explicit RenderServer(int workers) {
+        for (int i = 0; i < 3; ++i)
+            arenas[i].initialize(tbb::task_arena::automatic, 1, arena_priority(i));
+        for (int i = 0; i < workers; ++i)
+            dispatchers.emplace_back([this] { dispatch(); });
+    }
+
+    ~RenderServer() {
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            stopping = true;
+        }
+        queue_cv.notify_all();
+        for (auto& t : dispatchers) t.join();
+    }
+
+    void handle(const std::string& line) {
+        std::istringstream in(line);
+        std::string cmd, id;
+        in >> cmd >> id;
+        if (cmd.empty()) return;
+        if (id.empty()) return reply("error missing id for " + cmd);
+
+        std::map<std::string, std::string> args;
+        std::string token;
+        while (in >> token) {
+            auto eq = token.find('=');
+            if (eq == std::string::npos) return reply("error malformed argument " + token);
+            args[token.substr(0, eq)] = token.substr(eq + 1);
+        }
+
+        if (cmd == "load")
+            load(id, args.count("scene") ? args["scene"] : "random",
+                 args.count("accel") ? args["accel"] : "grid");
+        else if (cmd == "unload")
+            unload(id);
+        else if (cmd == "render")
+            submit(id, args);
+        else if (cmd == "cancel")
+            cancel(id);
+        else
+            reply("error unknown command " + cmd);
+    }
+
+private:
+    std::mutex scene_mutex;
+    std::unordered_map<std::string, shared_ptr<const ResidentScene>> scenes;
+
+    std::mutex queue_mutex;
+    std::condition_variable queue_cv;
+    std::priority_queue<shared_ptr<RenderJob>, std::vector<shared_ptr<RenderJob>>, JobOrder> queue;
+    std::unordered_map<std::string, shared_ptr<RenderJob>> active;
+    long next_sequence = 0;
+    bool stopping = false;
+
+    std::mutex out_mutex;
+    tbb::task_arena arenas[3];
+    std::vector<std::thread> dispatchers;
+
+    static tbb::task_arena::priority arena_priority(int p) {
+        if (p == 0) return tbb::task_arena::priority::low;
+        if (p == 2) return tbb::task_arena::priority::high;
+        return tbb::task_arena::priority::normal;
+    }
+
+    void reply(const std::string& msg) {
+        std::lock_guard<std::mutex> lock(out_mutex);
+        std::cout << msg << std::endl;
+    }
+
+    shared_ptr<const ResidentScene> load(const std::string& id, const std::string& name,
+                                         const std::string& accel_name) {
+        auto start = steady_clock::now();
+        AcceleratorType type;
+        if (!parse_accelerator(accel_name, type)) {
+            reply("error unknown accelerator " + accel_name);
+            return nullptr;
+        }
+        auto resident = make_shared<ResidentScene>();
+        if (!make_scene(name, resident->scene)) {
+            reply("error unknown scene " + name);
+            return nullptr;
+        }
+        resident->accel = make_accelerator(type, resident->scene.world);
+        {
+            std::lock_guard<std::mutex> lock(scene_mutex);
+            scenes[id] = resident;
+        }
+        auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+        reply("loaded " + id + " " + std::to_string(ms));
+        return resident;
+    }
+
+    void unload(const std::string& id) {
+        // running jobs hold their own reference, so this never pulls a scene from under them
+        std::lock_guard<std::mutex> lock(scene_mutex);
+        scenes.erase(id);
+    }
+
+    shared_ptr<const ResidentScene> find_scene(const std::string& id) {
+        {
+            std::lock_guard<std::mutex> lock(scene_mutex);
+            auto it = scenes.find(id);
+            if (it != scenes.end()) return it->second;
+        }
+        return load(id, id, "grid");
+    }
+
+    static bool parse_vec3(const std::string& s, Vec3& v) {
+        char c1, c2;
+        std::istringstream in(s);
+        return static_cast<bool>(in >> v.x >> c1 >> v.y >> c2 >> v.z) && c1 == ',' && c2 == ',';
+    }
+
+    void submit(const std::string& id, std::map<std::string, std::string>& args) {
+        auto job = make_shared<RenderJob>();
+        job->id = id;
+        job->output = id + ".ppm";
+        try {
+            for (const auto& kv : args) {
+                const auto& key = kv.first;
+                const auto& val = kv.second;
+                if (key == "scene") {
+                    if (!(job->resident = find_scene(val))) return;
+                } else if (key == "width") job->width = std::stoi(val);
+                else if (key == "spp") job->samples_per_pixel = std::stoi(val);
+                else if (key == "depth") job->max_depth = std::stoi(val);
+                else if (key == "aspect") job->aspect_ratio = std::stod(val);
+                else if (key == "out") job->output = val;
+                else if (key == "fov") job->vfov = std::stod(val);
+                else if (key == "aperture") job->aperture = std::stod(val);
+                else if (key == "priority") {
+                    if (val == "low") job->priority = 0;
+                    else if (val == "normal") job->priority = 1;
+                    else if (val == "high") job->priority = 2;
+                    else return reply("error bad priority " + val);
+                } else if (key != "from" && key != "at") {
+                    return reply("error unknown argument " + key);
+                }
+            }
+        } catch (const std::exception&) {
+            return reply("error bad value for job " + id);
+        }
+        if (!job->resident) return reply("error job " + id + " names no scene");
+        // both sides need two pixels, sample positions divide by width - 1 and height - 1
+        // a non-finite aspect would reach the int conversion of the height in run()
+        if (!std::isfinite(job->aspect_ratio) || job->aspect_ratio <= 0 || job->width < 2
+            || job->width / job->aspect_ratio < 2 || job->samples_per_pixel < 1)
+            return reply("error bad frame settings for job " + id);
+
+        const Scene& scene = job->resident->scene;
+        job->look_from = scene.look_from;
+        job->look_at = scene.look_at;
+        if (!args.count("fov")) job->vfov = scene.vfov;
+        if (!args.count("aperture")) job->aperture = scene.aperture;
+        if (args.count("from") && !parse_vec3(args["from"], job->look_from))
+            return reply("error bad from for job " + id);
+        if (args.count("at") && !parse_vec3(args["at"], job->look_at))
+            return reply("error bad at for job " + id);
+        if (job->look_from == job->look_at || !(job->vfov > 0 && job->vfov < 180))
+            return reply("error bad camera for job " + id);
+
+        // fail before queuing rather than after the first pass, append keeps an existing image intact
+        if (!std::ofstream(job->output, std::ios::app))
+            return reply("error cannot write " + job->output + " for job " + id);
+
+        {
+            std::lock_guard<std::mutex> lock(queue_mutex);
+            if (active.count(id)) return reply("error job " + id + " already exists");
+            job->sequence = next_sequence++;
+            active[id] = job;
+            queue.push(job);
+        }
+        reply("queued " + id);
+        queue_cv.notify_one();
+    }
+
+    void cancel(const std::string& id) {
+        std::lock_guard<std::mutex> lock(queue_mutex);
+        auto it = active.find(id);
+        if (it == active.end()) return reply("error no job " + id);
+        // queued jobs are dropped when a dispatcher pops them
+        it->second->cancelled = true;
+    }
+
+    void dispatch() {
+        while (true) {
+            shared_ptr<RenderJob> job;
+            {
+                std::unique_lock<std::mutex> lock(queue_mutex);
+                queue_cv.wait(lock, [this] { return stopping || !queue.empty(); });
+                // quit drains the queue, cancel jobs first to drop them
+                if (queue.empty()) return;
+                job = queue.top();
+                queue.pop();
+            }
+            arenas[job->priority].execute([&] { run(*job); });
+            {
+                std::lock_guard<std::mutex> lock(queue_mutex);
+                active.erase(job->id);
+            }
+        }
+    }
+
+    void run(RenderJob& job) {
+        auto start = steady_clock::now();
+        const int image_width = job.width;
+        const int image_height = static_cast<int>(image_width / job.aspect_ratio);
+
+        Camera camera(job.look_from, job.look_at, job.resident->scene.vup, job.vfov, job.aspect_ratio,
+                      job.aperture, (job.look_from - job.look_at).length());
+        PPM image(image_width, image_height, 0);
+
+        int done = 0;
+        int pass = 1;
+        while (done < job.samples_per_pixel) {
+            if (job.cancelled) break;
+            int spp = std::min(pass, job.samples_per_pixel - done);
+            tbb_shading shading(image, camera, *job.resident->accel, image_width, image_height, spp, job.max_depth);
+            shading.accumulate = true;
+            shading.cancelled = &job.cancelled;
+            tbb::parallel_for(tbb::blocked_range2d<int>(0, image_width, 0, image_height), shading);
+            // a pass cut short leaves some pixels with fewer samples, do not publish it
+            if (job.cancelled) break;
+
+            done += spp;
+            pass *= 2;
+            image.samples_per_pixel = done;
+            if (!image.write_to_file(job.output))
+                return reply("error cannot write " + job.output + " for job " + job.id);
+            reply("progress " + job.id + " " + std::to_string(done) + " "
+                  + std::to_string(job.samples_per_pixel) + " " + job.output);
+        }
+
+        if (job.cancelled) {
+            reply("cancelled " + job.id);
+            return;
+        }
+        auto ms = duration_cast<milliseconds>(steady_clock::now() - start).count();
+        reply("done " + job.id + " " + std::to_string(ms));
+    }
+};
+
+int main(int argc, char** argv) {
+    // number of jobs rendered side by side, they share the tbb worker pool
+    int workers = argc > 1 ? std::max(1, std::atoi(argv[1])) : 2;
+
+    RenderServer server(workers);
+    std::string line;
+    while (std::getline(std::cin, line)) {
+        if (line == "quit") break;
+        server.handle(line);
+    }
+    return 0;
+}